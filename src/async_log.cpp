@@ -0,0 +1,284 @@
+#include "async_log.h"
+#include <Windows.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <plog/Record.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AsyncLog {
+
+// single producer (the owner thread), single consumer (the log thread)
+struct Ring {
+  static constexpr uint32_t SIZE = 1024;
+  Record records[SIZE];
+  std::atomic<uint32_t> head = 0;
+  std::atomic<uint32_t> tail = 0;
+  uint32_t thread_id = 0;
+  Ring *next = nullptr;
+};
+
+// a PLOG_* record. the message is already formatted by plog
+struct PlogEntry {
+  int64_t time;
+  uint8_t severity;
+  uint32_t thread_id;
+  std::string func;
+  uint32_t line;
+  std::wstring message;
+};
+
+// rings live until the process exits. pushed once per thread
+static std::atomic<Ring *> g_rings = nullptr;
+static std::atomic<uint64_t> g_dropped = 0;
+static std::atomic<bool> g_running = false;
+static std::thread g_thread;
+
+// PLOG_* is not on the hot path. a locked queue is enough
+constexpr size_t MAX_PLOG_ENTRIES = 4096;
+static std::mutex g_plog_mutex;
+static std::vector<PlogEntry> g_plog_entries;
+
+// auto-reset. set by producers only while the log thread waits
+static HANDLE g_wakeup = nullptr;
+static std::atomic<bool> g_waiting = false;
+
+static void Wake() {
+  // pairs with the fence in the log thread
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (g_waiting.load(std::memory_order_relaxed) && g_waiting.exchange(false)) {
+    SetEvent(g_wakeup);
+  }
+}
+
+static Ring *ThreadRing() {
+  thread_local Ring *ring = nullptr;
+  if (!ring) {
+    ring = new Ring;
+    ring->thread_id = GetCurrentThreadId();
+    ring->next = g_rings.load(std::memory_order_relaxed);
+    while (!g_rings.compare_exchange_weak(ring->next, ring,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+    }
+  }
+  return ring;
+}
+
+int64_t Now() {
+  // orders records across threads. the coarse clock ties too often
+  FILETIME ft;
+  GetSystemTimePreciseAsFileTime(&ft);
+  return (static_cast<int64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+bool Push(const Record &record) {
+  auto ring = ThreadRing();
+  auto head = ring->head.load(std::memory_order_relaxed);
+  if (head - ring->tail.load(std::memory_order_acquire) >= Ring::SIZE) {
+    g_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  ring->records[head % Ring::SIZE] = record;
+  ring->head.store(head + 1, std::memory_order_release);
+  Wake();
+  return true;
+}
+
+uint64_t Dropped() { return g_dropped.load(std::memory_order_relaxed); }
+
+static void AppendArg(std::string *out, const Arg &arg) {
+  char buf[32];
+  switch (arg.type) {
+  case ArgType::Int:
+    snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(arg.i));
+    break;
+  case ArgType::UInt:
+    snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(arg.u));
+    break;
+  case ArgType::Double:
+    snprintf(buf, sizeof(buf), "%g", arg.d);
+    break;
+  case ArgType::Str:
+    out->append(arg.s ? arg.s : "(null)");
+    return;
+  }
+  out->append(buf);
+}
+
+// same layout as plog::TxtFormatter
+static void FormatHeader(std::string *out, int64_t time, uint8_t severity,
+                         uint32_t thread_id, const char *func,
+                         uint32_t line) {
+  FILETIME utc{static_cast<DWORD>(time), static_cast<DWORD>(time >> 32)};
+  FILETIME local;
+  SYSTEMTIME t;
+  FileTimeToLocalFileTime(&utc, &local);
+  FileTimeToSystemTime(&local, &t);
+
+  char header[256];
+  snprintf(header, sizeof(header),
+           "%04d-%02d-%02d %02d:%02d:%02d.%03d %-5s [%u] [%s@%u] ", t.wYear,
+           t.wMonth, t.wDay, t.wHour, t.wMinute, t.wSecond, t.wMilliseconds,
+           plog::severityToString(static_cast<plog::Severity>(severity)),
+           thread_id, func, line);
+  out->assign(header);
+}
+
+static void Format(std::string *out, const Record &record,
+                   uint32_t thread_id) {
+  FormatHeader(out, record.time, record.severity, thread_id, record.func,
+               record.line);
+
+  uint8_t arg_index = 0;
+  for (auto p = record.format; *p; ++p) {
+    if (p[0] == '{' && p[1] == '}' && arg_index < record.argc) {
+      AppendArg(out, record.args[arg_index++]);
+      ++p;
+    } else {
+      out->push_back(*p);
+    }
+  }
+  out->push_back('\n');
+}
+
+static void Output(const PlogEntry &entry) {
+  std::string header;
+  FormatHeader(&header, entry.time, entry.severity, entry.thread_id,
+               entry.func.c_str(), entry.line);
+  // the header is ascii
+  std::wstring line(header.begin(), header.end());
+  line += entry.message;
+  line.push_back(L'\n');
+  OutputDebugStringW(line.c_str());
+}
+
+void Appender::write(const plog::Record &record) {
+  PlogEntry entry{
+      .time = Now(),
+      .severity = static_cast<uint8_t>(record.getSeverity()),
+      .thread_id = record.getTid(),
+      .func = record.getFunc(),
+      .line = static_cast<uint32_t>(record.getLine()),
+      .message = record.getMessage(),
+  };
+  if (!g_running.load(std::memory_order_relaxed)) {
+    // before Start or after Stop
+    Output(entry);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_plog_mutex);
+    if (g_plog_entries.size() >= MAX_PLOG_ENTRIES) {
+      g_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    g_plog_entries.push_back(std::move(entry));
+  }
+  Wake();
+}
+
+// a record or a plog entry waiting for output
+struct Pending {
+  int64_t time;
+  const Record *record;
+  uint32_t thread_id;
+  const PlogEntry *entry;
+};
+
+struct RingHead {
+  Ring *ring;
+  uint32_t head;
+};
+
+// only called on the log thread
+static bool Drain(std::string *line) {
+  static std::vector<PlogEntry> plog_entries;
+  static std::vector<RingHead> heads;
+  static std::vector<Pending> pending;
+  {
+    std::lock_guard<std::mutex> lock(g_plog_mutex);
+    plog_entries.swap(g_plog_entries);
+  }
+
+  // records stay in the rings until the tail moves
+  pending.clear();
+  heads.clear();
+  for (auto ring = g_rings.load(std::memory_order_acquire); ring;
+       ring = ring->next) {
+    auto tail = ring->tail.load(std::memory_order_relaxed);
+    auto head = ring->head.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) {
+      auto &record = ring->records[tail % Ring::SIZE];
+      pending.push_back({record.time, &record, ring->thread_id, nullptr});
+    }
+    heads.push_back({ring, head});
+  }
+  for (auto &entry : plog_entries) {
+    pending.push_back({entry.time, nullptr, entry.thread_id, &entry});
+  }
+
+  // merge NVY_LOG* and PLOG_* by time
+  std::stable_sort(
+      pending.begin(), pending.end(),
+      [](const Pending &l, const Pending &r) { return l.time < r.time; });
+  for (auto &p : pending) {
+    if (p.record) {
+      Format(line, *p.record, p.thread_id);
+      OutputDebugStringA(line->c_str());
+    } else {
+      Output(*p.entry);
+    }
+  }
+
+  for (auto &h : heads) {
+    h.ring->tail.store(h.head, std::memory_order_release);
+  }
+  plog_entries.clear();
+  return !pending.empty();
+}
+
+void Start() {
+  if (g_running.exchange(true)) {
+    return;
+  }
+  g_wakeup = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+  g_thread = std::thread([]() {
+    std::string line;
+    while (g_running.load(std::memory_order_relaxed)) {
+      if (Drain(&line)) {
+        continue;
+      }
+      // publish the wait, then check again for a push that missed it
+      g_waiting.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (Drain(&line) || !g_running.load(std::memory_order_relaxed)) {
+        g_waiting.store(false, std::memory_order_relaxed);
+        continue;
+      }
+      WaitForSingleObject(g_wakeup, INFINITE);
+    }
+    Drain(&line);
+  });
+}
+
+void Stop() {
+  if (!g_running.exchange(false)) {
+    return;
+  }
+  SetEvent(g_wakeup);
+  g_thread.join();
+  CloseHandle(g_wakeup);
+  g_wakeup = nullptr;
+  if (auto dropped = Dropped()) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "AsyncLog: %llu records dropped\n",
+             static_cast<unsigned long long>(dropped));
+    OutputDebugStringA(buf);
+  }
+}
+
+} // namespace AsyncLog
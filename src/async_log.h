@@ -0,0 +1,141 @@
+#pragma once
+#include <plog/Appenders/IAppender.h>
+#include <plog/Severity.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+// plog::Severity. lower levels compile to nothing
+#ifndef NVY_LOG_LEVEL
+#define NVY_LOG_LEVEL 6
+#endif
+
+///
+/// Producer threads copy a fixed size binary record into their own
+/// lock-free ring. A background thread formats and outputs them.
+///
+namespace AsyncLog {
+
+enum class ArgType : uint8_t { Int, UInt, Double, Str };
+
+struct Arg {
+  ArgType type;
+  union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    // a string literal. the pointer is read on the log thread
+    const char *s;
+  };
+};
+
+constexpr size_t MAX_ARGS = 4;
+
+struct Record {
+  int64_t time;
+  // "{}" is replaced by args in order
+  const char *format;
+  const char *func;
+  uint32_t line;
+  uint8_t severity;
+  uint8_t argc;
+  Arg args[MAX_ARGS];
+};
+
+void Start();
+// flush remaining records and join the log thread
+void Stop();
+// false if the ring of this thread is full
+bool Push(const Record &record);
+uint64_t Dropped();
+
+struct Scope {
+  Scope() { Start(); }
+  ~Scope() { Stop(); }
+};
+
+///
+/// Routes PLOG_* to the log thread, which outputs them in time order with
+/// NVY_LOG*. Not free on the caller's thread: plog has already formatted
+/// the message, and write copies it and the function name (two heap
+/// allocations) into a queue under a mutex. Hot paths use NVY_LOG*.
+///
+class Appender : public plog::IAppender {
+public:
+  void write(const plog::Record &record) override;
+};
+
+template <typename T> Arg MakeArg(const T &value) {
+  static_assert(!std::is_pointer_v<T>,
+                "log strings must be literals. the log thread reads them later");
+  Arg arg;
+  if constexpr (std::is_array_v<T>) {
+    static_assert(std::is_same_v<std::remove_extent_t<T>, char>,
+                  "unsupported log argument");
+    arg.type = ArgType::Str;
+    arg.s = value;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    arg.type = ArgType::Double;
+    arg.d = value;
+  } else if constexpr (std::is_enum_v<T>) {
+    arg.type = ArgType::Int;
+    arg.i = static_cast<int64_t>(value);
+  } else if constexpr (std::is_signed_v<T>) {
+    arg.type = ArgType::Int;
+    arg.i = value;
+  } else {
+    static_assert(std::is_arithmetic_v<T>, "unsupported log argument");
+    arg.type = ArgType::UInt;
+    arg.u = value;
+  }
+  return arg;
+}
+
+int64_t Now();
+
+template <size_t N, typename... ARGS>
+void Write(plog::Severity severity, const char *func, uint32_t line,
+           const char (&format)[N], const ARGS &...args) {
+  static_assert(sizeof...(ARGS) <= MAX_ARGS, "too many log arguments");
+  Record record{
+      .time = Now(),
+      .format = format,
+      .func = func,
+      .line = line,
+      .severity = static_cast<uint8_t>(severity),
+      .argc = static_cast<uint8_t>(sizeof...(ARGS)),
+      .args = {MakeArg(args)...},
+  };
+  Push(record);
+}
+
+} // namespace AsyncLog
+
+#define NVY_LOG_(severity, format, ...)                                        \
+  AsyncLog::Write(severity, __FUNCTION__, __LINE__, format, ##__VA_ARGS__)
+
+#if NVY_LOG_LEVEL >= 6
+#define NVY_LOGV(...) NVY_LOG_(plog::verbose, __VA_ARGS__)
+#else
+#define NVY_LOGV(...) ((void)0)
+#endif
+#if NVY_LOG_LEVEL >= 5
+#define NVY_LOGD(...) NVY_LOG_(plog::debug, __VA_ARGS__)
+#else
+#define NVY_LOGD(...) ((void)0)
+#endif
+#if NVY_LOG_LEVEL >= 4
+#define NVY_LOGI(...) NVY_LOG_(plog::info, __VA_ARGS__)
+#else
+#define NVY_LOGI(...) ((void)0)
+#endif
+#if NVY_LOG_LEVEL >= 3
+#define NVY_LOGW(...) NVY_LOG_(plog::warning, __VA_ARGS__)
+#else
+#define NVY_LOGW(...) ((void)0)
+#endif
+#if NVY_LOG_LEVEL >= 2
+#define NVY_LOGE(...) NVY_LOG_(plog::error, __VA_ARGS__)
+#else
+#define NVY_LOGE(...) ((void)0)
+#endif
@@ -0,0 +1,75 @@
+#include "client_stats.h"
+#include "async_log.h"
+#include "nvim_rpc.h"
+#include <Windows.h>
+#include <psapi.h>
+#include <stdio.h>
+
+bool ClientStats::AddFrame(double process_ms, double present_ms) {
+  ++_frames;
+  _process_ms += process_ms;
+  _present_ms += present_ms;
+
+  auto now = clock::now();
+  auto window_ms =
+      std::chrono::duration<double, std::milli>(now - _window_start).count();
+  if (window_ms < 1000.0) {
+    return false;
+  }
+
+  _fps = static_cast<float>(_frames * 1000.0 / window_ms);
+  _frame_ms = static_cast<float>(window_ms / _frames);
+  _avg_process_ms = static_cast<float>(_process_ms / _frames);
+  _avg_present_ms = static_cast<float>(_present_ms / _frames);
+  _paste_bytes_per_sec = static_cast<float>(_paste_bytes * 1000.0 / window_ms);
+
+  PROCESS_MEMORY_COUNTERS_EX memory{.cb = sizeof(memory)};
+  if (GetProcessMemoryInfo(
+          GetCurrentProcess(),
+          reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&memory), memory.cb)) {
+    _working_set = memory.WorkingSetSize;
+    _private_bytes = memory.PrivateUsage;
+  }
+
+  _window_start = now;
+  _frames = 0;
+  _process_ms = 0;
+  _present_ms = 0;
+  _paste_bytes = 0;
+  return true;
+}
+
+std::wstring ClientStats::Format() const {
+  wchar_t buf[256];
+  swprintf_s(buf,
+             L"%.1f fps  %.2f ms/frame\n"
+             L"process %.2f ms  present %.2f ms\n"
+             L"paste %.0f B/s\n"
+             L"working set %.1f MB  private %.1f MB\n"
+             L"log dropped %llu",
+             _fps, _frame_ms, _avg_process_ms, _avg_present_ms,
+             _paste_bytes_per_sec, _working_set / (1024.0 * 1024.0),
+             _private_bytes / (1024.0 * 1024.0),
+             static_cast<unsigned long long>(AsyncLog::Dropped()));
+  return buf;
+}
+
+void ClientStats::Pack(MsgpackWriter *out) const {
+  out->Map(8)
+      .Str("fps")
+      .Double(_fps)
+      .Str("frame_ms")
+      .Double(_frame_ms)
+      .Str("process_ms")
+      .Double(_avg_process_ms)
+      .Str("present_ms")
+      .Double(_avg_present_ms)
+      .Str("paste_bytes_per_sec")
+      .Double(_paste_bytes_per_sec)
+      .Str("working_set")
+      .Int(static_cast<int64_t>(_working_set))
+      .Str("private_bytes")
+      .Int(static_cast<int64_t>(_private_bytes))
+      .Str("log_dropped")
+      .Int(static_cast<int64_t>(AsyncLog::Dropped()));
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+#include <stdint.h>
+#include <string>
+
+class MsgpackWriter;
+
+///
+/// Main loop counters, averaged over one second windows.
+///
+class ClientStats {
+  using clock = std::chrono::steady_clock;
+  clock::time_point _window_start = clock::now();
+  uint32_t _frames = 0;
+  double _process_ms = 0;
+  double _present_ms = 0;
+  uint64_t _paste_bytes = 0;
+
+  // last completed window
+  float _fps = 0;
+  float _frame_ms = 0;
+  float _avg_process_ms = 0;
+  float _avg_present_ms = 0;
+  float _paste_bytes_per_sec = 0;
+  uint64_t _working_set = 0;
+  uint64_t _private_bytes = 0;
+
+public:
+  // true when a new window has been published
+  bool AddFrame(double process_ms, double present_ms);
+  void AddPaste(size_t bytes) { _paste_bytes += bytes; }
+  float Fps() const { return _fps; }
+  float FrameMs() const { return _frame_ms; }
+  uint64_t WorkingSet() const { return _working_set; }
+  std::wstring Format() const;
+  // a map for g:nvy_stats
+  void Pack(MsgpackWriter *out) const;
+};
@@ -8,16 +8,27 @@ constexpr int MAX_NVIM_CMD_LINE_SIZE = 32767;
 struct CommandLine {
   bool start_maximized = false;
   bool disable_ligatures = false;
+  bool use_warp = false;
+  bool show_stats = false;
+  bool no_snapshot = false;
   float linespace_factor = 1.0f;
+  // seconds minimized before memory is trimmed. 0 disables
+  int64_t trim_after = 60;
   int64_t rows = 0;
   int64_t cols = 0;
   wchar_t nvim_command_line[MAX_NVIM_CMD_LINE_SIZE] = {};
+  // nvim --listen. the NvimRpc channel
+  wchar_t nvim_listen_address[64] = {};
 
   void Parse() {
     int n_args;
     auto cmd_line_args = CommandLineToArgvW(GetCommandLineW(), &n_args);
-    int cmd_line_size_left = MAX_NVIM_CMD_LINE_SIZE - wcslen(L"nvim --embed");
-    wcscpy_s(nvim_command_line, MAX_NVIM_CMD_LINE_SIZE, L"nvim --embed");
+    swprintf_s(nvim_listen_address, L"\\\\.\\pipe\\nvy-%lu",
+               GetCurrentProcessId());
+    swprintf_s(nvim_command_line, L"nvim --embed --listen %s",
+               nvim_listen_address);
+    int cmd_line_size_left =
+        MAX_NVIM_CMD_LINE_SIZE - wcslen(nvim_command_line);
 
     // Skip argv[0]
     for (int i = 1; i < n_args; ++i) {
@@ -25,11 +36,23 @@ struct CommandLine {
         start_maximized = true;
       } else if (!wcscmp(cmd_line_args[i], L"--disable-ligatures")) {
         disable_ligatures = true;
+      } else if (!wcscmp(cmd_line_args[i], L"--warp")) {
+        use_warp = true;
+      } else if (!wcscmp(cmd_line_args[i], L"--no-snapshot")) {
+        no_snapshot = true;
+      } else if (!wcscmp(cmd_line_args[i], L"--stats")) {
+        show_stats = true;
       } else if (!wcsncmp(cmd_line_args[i], L"--geometry=",
                           wcslen(L"--geometry="))) {
         wchar_t *end_ptr;
         cols = wcstol(&cmd_line_args[i][11], &end_ptr, 10);
         rows = wcstol(end_ptr + 1, nullptr, 10);
+      } else if (!wcsncmp(cmd_line_args[i], L"--trim-after=",
+                          wcslen(L"--trim-after="))) {
+        auto seconds = wcstol(&cmd_line_args[i][13], nullptr, 10);
+        if (seconds >= 0) {
+          trim_after = seconds;
+        }
       } else if (!wcsncmp(cmd_line_args[i], L"--linespace-factor=",
                           wcslen(L"--linespace-factor="))) {
         wchar_t *end_ptr;
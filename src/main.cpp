@@ -1,19 +1,35 @@
+#include "async_log.h"
+#include "client_stats.h"
 #include "commandline.h"
+#include "memory_trimmer.h"
+#include "nvim_rpc.h"
+#include "paste_stream.h"
 #include "renderer/d3d.h"
+#include "renderer/frame_snapshot.h"
+#include "renderer/stats_overlay.h"
 #include "renderer/swapchain.h"
 #include "win32window.h"
 #include <Windows.h>
+#include <chrono>
 #include <nvim_frontend.h>
 #include <nvim_renderer_d2d.h>
-#include <plog/Appenders/DebugOutputAppender.h>
-#include <plog/Formatters/TxtFormatter.h>
 #include <plog/Init.h>
 #include <plog/Log.h>
 
 int WINAPI wWinMain(HINSTANCE instance, HINSTANCE prev_instance,
                     PWSTR p_cmd_line, int n_cmd_show) {
-  static plog::DebugOutputAppender<plog::TxtFormatter> debugOutputAppender;
-  plog::init(plog::verbose, &debugOutputAppender);
+  auto start_time = std::chrono::steady_clock::now();
+  auto elapsed_ms = [start_time]() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start_time)
+        .count();
+  };
+
+  // PLOG_* and NVY_LOG* only copy the record. the log thread formats and
+  // outputs
+  static AsyncLog::Appender asyncLogAppender;
+  plog::init(plog::verbose, &asyncLogAppender);
+  AsyncLog::Scope async_log;
 
   SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE);
 
@@ -26,6 +42,47 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE prev_instance,
   if (!hwnd) {
     return 1;
   }
+  auto dpi = window.GetMonitorDpi();
+
+  // create swapchain before nvim, to show the last frame while nvim loads
+  auto d3d = D3D::Create(cmd.use_warp);
+  if (!d3d) {
+    return 4;
+  }
+  if (d3d->IsWarp()) {
+    NVY_LOGI("d3d device: warp");
+  } else {
+    NVY_LOGI("d3d device: hardware");
+  }
+  auto swapchain = Swapchain::Create(d3d->Device(), hwnd);
+
+  // replaced by the first redraw. skipped if the window size is requested
+  auto snapshot_path = FrameSnapshot::DefaultPath();
+  if (cmd.no_snapshot && !snapshot_path.empty()) {
+    // do not leave the frame of an earlier session on disk
+    DeleteFileW(snapshot_path.c_str());
+    snapshot_path.clear();
+  }
+  if (!snapshot_path.empty() && !cmd.start_maximized &&
+      (cmd.rows == 0 || cmd.cols == 0)) {
+    auto snapshot = FrameSnapshot::Load(snapshot_path.c_str());
+    // a maximized size does not fit a restored window
+    if (snapshot && snapshot->Dpi() == dpi && !snapshot->Maximized()) {
+      RECT rect = {0, 0, static_cast<LONG>(snapshot->Width()),
+                   static_cast<LONG>(snapshot->Height())};
+      AdjustWindowRect(&rect, WS_OVERLAPPEDWINDOW, false);
+      window.Resize(rect.right - rect.left, rect.bottom - rect.top);
+      auto [window_width, window_height] = window.Size();
+      swapchain->Resize(window_width, window_height);
+      if (snapshot->Restore(d3d->Device(), d3d->Context(),
+                            swapchain->GetBackbuffer().Get())) {
+        ShowWindow(hwnd, SW_SHOWDEFAULT);
+        swapchain->PresentCopyFrontToBack(d3d->Context());
+        NVY_LOGI("time to first pixel: {} ms (snapshot {} bytes)",
+                 elapsed_ms(), snapshot->PackedBytes());
+      }
+    }
+  }
 
   // launch nvim
   NvimFrontend nvim;
@@ -34,15 +91,11 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE prev_instance,
     return 3;
   }
   auto [font, size] = nvim.Initialize();
+  NvimRpc rpc(cmd.nvim_listen_address);
 
   // setup renderer
-  // create swapchain
-  auto d3d = D3D::Create();
-  auto swapchain = Swapchain::Create(d3d->Device(), hwnd);
-
   NvimRendererD2D renderer(d3d->Device().Get(), nvim.DefaultAttribute(),
-                           cmd.disable_ligatures, cmd.linespace_factor,
-                           window.GetMonitorDpi());
+                           cmd.disable_ligatures, cmd.linespace_factor, dpi);
   renderer.SetFont(font, size);
 
   // initial window size
@@ -61,6 +114,8 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE prev_instance,
   UpdateWindow(hwnd);
   ShowWindow(hwnd, SW_SHOWDEFAULT);
 
+  MemoryTrimmer trimmer(std::chrono::seconds(cmd.trim_after));
+
   // bind window event
   window._on_input = [&nvim](const Nvim::InputEvent &input) { nvim.Input(input); };
   window._on_mouse = [&nvim, &renderer](const Nvim::MouseEvent &mouse) {
@@ -72,9 +127,13 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE prev_instance,
     copy.y = grid_pos.row;
     nvim.Mouse(copy);
   };
-  window._on_drop_file = [&nvim](const wchar_t *file) {
-    nvim.OpenFile(file);
+  window._on_drop_files = [&rpc](const std::vector<std::wstring> &files) {
+    // one command for all files
+    rpc.OpenFiles(files);
   };
+  PasteStream paste;
+  // ignored while a paste is streaming
+  window._on_paste = [&paste]() { paste.Begin(); };
 
   // Attach the renderer now that the window size is determined
   auto [window_width, window_height] = window.Size();
@@ -85,13 +144,43 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE prev_instance,
   // nvim_attach_ui. start redraw message
   nvim.AttachUI(&renderer, gridSize.rows, gridSize.cols);
 
+  ClientStats stats;
+  std::wstring stats_text;
+  std::unique_ptr<StatsOverlay> overlay;
+  // :NvyStats. defined on the first publish that reaches nvim
+  bool stats_command = false;
+  bool stats_command_warned = false;
+  if (cmd.show_stats) {
+    overlay = StatsOverlay::Create(d3d->Device(), dpi);
+  }
+
   // main loop
+  bool live = false;
   while (window.Loop()) {
+    if (overlay && window.IsMinimized()) {
+      // the trimmer resizes the swapchain
+      overlay->ReleaseTarget();
+    }
+    trimmer.Update(window.IsMinimized(), d3d.get(), swapchain.get());
+    if (trimmer.IsSuspended()) {
+      // keep draining nvim at a low rate so messages do not pile up.
+      // drawn into the window size target, copied back on resume
+      renderer.SetTarget(trimmer.Target());
+      nvim.Process();
+      renderer.SetTarget(nullptr);
+      window.Wait(100);
+      continue;
+    }
+
     auto [window_width, window_height] = window.Size();
 
     // update swapchain size
     auto [w, h] = swapchain->GetSize();
-    if (window_width != w || window_height != h) {
+    if (!window.IsMinimized() && (window_width != w || window_height != h)) {
+      NVY_LOGD("swapchain resize {}x{}", window_width, window_height);
+      if (overlay) {
+        overlay->ReleaseTarget();
+      }
       HRESULT hr = swapchain->Resize(window_width, window_height);
       if (hr == DXGI_ERROR_DEVICE_REMOVED) {
         assert(false);
@@ -105,13 +194,18 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE prev_instance,
     if (nvim.Sizing()) {
       auto a = 0;
     } else {
-      if (nvim.GridSize() != gridSize) {
+      if (!window.IsMinimized() && nvim.GridSize() != gridSize) {
+        NVY_LOGD("grid resize {}x{}", gridSize.cols, gridSize.rows);
         nvim.SetSizing();
         nvim.ResizeGrid(gridSize.rows, gridSize.cols);
       }
     }
 
+    // at most one nvim_paste chunk per frame
+    stats.AddPaste(paste.Pump(&rpc));
+
     {
+      auto frame_start = std::chrono::steady_clock::now();
       // parepare render target
       renderer.SetTarget(swapchain->GetBackbuffer().Get());
       // process nvim message. may render
@@ -119,12 +213,82 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE prev_instance,
       // release backbuffer reference
       renderer.SetTarget(nullptr);
 
+      if (!live && !nvim.Sizing() && nvim.GridSize() == gridSize) {
+        // the grid_resize reply has been drawn over the snapshot
+        live = true;
+        NVY_LOGI("time to live frame: {} ms", elapsed_ms());
+      }
+      auto process_end = std::chrono::steady_clock::now();
+
+      if (overlay && overlay->IsLost()) {
+        overlay = StatsOverlay::Create(d3d->Device(), dpi);
+        if (overlay) {
+          overlay->SetText(stats_text);
+        }
+      }
+      if (overlay && !window.IsMinimized()) {
+        overlay->Draw(d3d->Device(), d3d->Context(),
+                      swapchain->GetBackbuffer().Get());
+      }
+
       // present
       auto hr = swapchain->PresentCopyFrontToBack(d3d->Context());
       if (hr == DXGI_ERROR_DEVICE_REMOVED) {
         assert(false);
         // this->HandleDeviceLost();
       }
+
+      if (overlay) {
+        // the new backbuffer is a copy of the frame with the overlay
+        overlay->Restore(d3d->Context(), swapchain->GetBackbuffer().Get());
+      }
+
+      auto present_end = std::chrono::steady_clock::now();
+      if (stats.AddFrame(
+              std::chrono::duration<double, std::milli>(process_end -
+                                                        frame_start)
+                  .count(),
+              std::chrono::duration<double, std::milli>(present_end -
+                                                        process_end)
+                  .count())) {
+        NVY_LOGD("{} fps, {} ms/frame, working set {}", stats.Fps(),
+                 stats.FrameMs(), stats.WorkingSet());
+        if (overlay) {
+          // the layout is rebuilt only here
+          stats_text = stats.Format();
+          overlay->SetText(stats_text);
+        }
+        // without --stats nvim is never woken for the counters
+        if (cmd.show_stats) {
+          if (!stats_command) {
+            MsgpackWriter command;
+            command.Array(1).Str(
+                "command! NvyStats lua print(vim.inspect(vim.g.nvy_stats))");
+            stats_command = rpc.Notify("nvim_command", command);
+            if (!stats_command && !stats_command_warned) {
+              // retried with the next publish
+              NVY_LOGW(":NvyStats: rpc pipe not connected");
+              stats_command_warned = true;
+            }
+          }
+          MsgpackWriter params;
+          params.Array(2).Str("nvy_stats");
+          stats.Pack(&params);
+          rpc.Notify("nvim_set_var", params);
+        }
+      }
+    }
+  }
+
+  // keep the last frame for the next launch
+  if (live && !snapshot_path.empty()) {
+    // the swapchain is 1x1 while suspended. nvim draws into the trimmer's
+    // target then
+    auto backbuffer = swapchain->GetBackbuffer();
+    auto source = trimmer.IsSuspended() ? trimmer.Target() : backbuffer.Get();
+    if (auto snapshot = FrameSnapshot::Capture(d3d->Device(), d3d->Context(),
+                                               source, dpi)) {
+      snapshot->Save(snapshot_path.c_str(), window.IsMaximized());
     }
   }
 
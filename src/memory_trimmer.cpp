@@ -0,0 +1,134 @@
+#include "memory_trimmer.h"
+#include "async_log.h"
+#include "renderer/d3d.h"
+#include "renderer/swapchain.h"
+#include <Windows.h>
+#include <psapi.h>
+template <typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+#if NVY_LOG_LEVEL >= 4
+struct MemoryUsage {
+  uint64_t working_set = 0;
+  uint64_t private_bytes = 0;
+};
+
+static MemoryUsage GetMemoryUsage() {
+  PROCESS_MEMORY_COUNTERS_EX memory{.cb = sizeof(memory)};
+  if (!GetProcessMemoryInfo(
+          GetCurrentProcess(),
+          reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&memory), memory.cb)) {
+    return {};
+  }
+  return {memory.WorkingSetSize, memory.PrivateUsage};
+}
+
+static int64_t Freed(uint64_t before, uint64_t after) {
+  return static_cast<int64_t>(before) - static_cast<int64_t>(after);
+}
+#endif
+
+// driver scratch memory and the process working set
+static void TrimDevice(D3D *d3d) {
+  d3d->Context()->ClearState();
+  d3d->Context()->Flush();
+  ComPtr<IDXGIDevice3> dxgi_device;
+  if (SUCCEEDED(d3d->Device().As(&dxgi_device))) {
+    dxgi_device->Trim();
+  }
+  SetProcessWorkingSetSize(GetCurrentProcess(), static_cast<SIZE_T>(-1),
+                           static_cast<SIZE_T>(-1));
+}
+
+MemoryTrimmer::MemoryTrimmer(std::chrono::seconds timeout)
+    : _timeout(timeout) {}
+
+MemoryTrimmer::~MemoryTrimmer() {}
+
+void MemoryTrimmer::Update(bool minimized, D3D *d3d, Swapchain *swapchain) {
+  auto now = clock::now();
+  if (minimized != _minimized) {
+    _minimized = minimized;
+    if (minimized) {
+      _minimized_since = now;
+    } else if (IsSuspended()) {
+      Resume(d3d, swapchain);
+    }
+  }
+
+  if (_minimized && !IsSuspended() && _timeout.count() > 0 &&
+      now - _minimized_since >= _timeout) {
+    Suspend(d3d, swapchain);
+  }
+}
+
+void MemoryTrimmer::Suspend(D3D *d3d, Swapchain *swapchain) {
+#if NVY_LOG_LEVEL >= 4
+  auto before = GetMemoryUsage();
+#endif
+  ComPtr<ID3D11Texture2D> backbuffer;
+  auto hr = swapchain->GetBackbuffer().As(&backbuffer);
+  if (FAILED(hr)) {
+    return;
+  }
+  D3D11_TEXTURE2D_DESC desc;
+  backbuffer->GetDesc(&desc);
+  desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+  desc.MiscFlags = 0;
+  desc.Usage = D3D11_USAGE_DEFAULT;
+  desc.CPUAccessFlags = 0;
+  ComPtr<ID3D11Texture2D> target;
+  hr = d3d->Device()->CreateTexture2D(&desc, nullptr, &target);
+  if (FAILED(hr)) {
+    return;
+  }
+  ComPtr<IDXGISurface2> target_surface;
+  hr = target.As(&target_surface);
+  if (FAILED(hr)) {
+    return;
+  }
+  d3d->Context()->CopyResource(target.Get(), backbuffer.Get());
+  // the swapchain cannot resize while its buffer is referenced
+  backbuffer.Reset();
+  hr = swapchain->Resize(1, 1);
+  if (FAILED(hr)) {
+    return;
+  }
+  _target = target;
+  _target_surface = target_surface;
+  TrimDevice(d3d);
+#if NVY_LOG_LEVEL >= 4
+  auto after = GetMemoryUsage();
+  NVY_LOGI("suspend: {}x{} target kept, working set -{}, private -{}",
+           desc.Width, desc.Height,
+           Freed(before.working_set, after.working_set),
+           Freed(before.private_bytes, after.private_bytes));
+#endif
+}
+
+void MemoryTrimmer::Resume(D3D *d3d, Swapchain *swapchain) {
+#if NVY_LOG_LEVEL >= 3
+  auto start = clock::now();
+#endif
+  D3D11_TEXTURE2D_DESC desc;
+  _target->GetDesc(&desc);
+  auto hr = swapchain->Resize(desc.Width, desc.Height);
+  ComPtr<ID3D11Texture2D> backbuffer;
+  if (SUCCEEDED(hr)) {
+    hr = swapchain->GetBackbuffer().As(&backbuffer);
+  }
+  if (SUCCEEDED(hr)) {
+    d3d->Context()->CopyResource(backbuffer.Get(), _target.Get());
+  }
+  _target_surface.Reset();
+  _target.Reset();
+#if NVY_LOG_LEVEL >= 3
+  auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        clock::now() - start)
+                        .count();
+  if (SUCCEEDED(hr)) {
+    NVY_LOGI("resume: restored in {} us", elapsed_us);
+  } else {
+    NVY_LOGW("resume: restore failed in {} us", elapsed_us);
+  }
+#endif
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+#include <d3d11_2.h>
+#include <dxgi1_3.h>
+#include <stdint.h>
+#include <wrl/client.h>
+
+class D3D;
+class Swapchain;
+
+///
+/// Releases memory after the window has been minimized for a while.
+/// While minimized the swapchain is shrunk to 1x1 and nvim keeps drawing
+/// into a single texture of the window size. Resume copies it back, so
+/// nvim is not asked for a redraw.
+///
+class MemoryTrimmer {
+  template <typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+  using clock = std::chrono::steady_clock;
+  // 0: never suspend
+  std::chrono::seconds _timeout;
+  clock::time_point _minimized_since;
+  bool _minimized = false;
+  ComPtr<ID3D11Texture2D> _target;
+  ComPtr<IDXGISurface2> _target_surface;
+
+  void Suspend(D3D *d3d, Swapchain *swapchain);
+  void Resume(D3D *d3d, Swapchain *swapchain);
+
+public:
+  MemoryTrimmer(std::chrono::seconds timeout);
+  ~MemoryTrimmer();
+  bool IsSuspended() const { return _target != nullptr; }
+  // the render target while suspended. holds the current frame
+  IDXGISurface2 *Target() const { return _target_surface.Get(); }
+  // call once per main loop iteration
+  void Update(bool minimized, D3D *d3d, Swapchain *swapchain);
+};
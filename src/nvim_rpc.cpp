@@ -0,0 +1,349 @@
+#include "nvim_rpc.h"
+#include <Windows.h>
+#include <string.h>
+
+static void PutBE(std::string *out, uint64_t value, int bytes) {
+  for (int i = bytes - 1; i >= 0; --i) {
+    out->push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+MsgpackWriter &MsgpackWriter::Nil() {
+  _buffer.push_back(static_cast<char>(0xC0));
+  return *this;
+}
+
+MsgpackWriter &MsgpackWriter::Bool(bool value) {
+  _buffer.push_back(static_cast<char>(value ? 0xC3 : 0xC2));
+  return *this;
+}
+
+MsgpackWriter &MsgpackWriter::Int(int64_t value) {
+  if (value >= 0 && value <= 0x7F) {
+    _buffer.push_back(static_cast<char>(value));
+  } else if (value < 0 && value >= -32) {
+    _buffer.push_back(static_cast<char>(value));
+  } else {
+    _buffer.push_back(static_cast<char>(0xD3));
+    PutBE(&_buffer, static_cast<uint64_t>(value), 8);
+  }
+  return *this;
+}
+
+MsgpackWriter &MsgpackWriter::Double(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  _buffer.push_back(static_cast<char>(0xCB));
+  PutBE(&_buffer, bits, 8);
+  return *this;
+}
+
+MsgpackWriter &MsgpackWriter::Str(std::string_view value) {
+  auto size = value.size();
+  if (size <= 31) {
+    _buffer.push_back(static_cast<char>(0xA0 | size));
+  } else if (size <= 0xFF) {
+    _buffer.push_back(static_cast<char>(0xD9));
+    PutBE(&_buffer, size, 1);
+  } else if (size <= 0xFFFF) {
+    _buffer.push_back(static_cast<char>(0xDA));
+    PutBE(&_buffer, size, 2);
+  } else {
+    _buffer.push_back(static_cast<char>(0xDB));
+    PutBE(&_buffer, size, 4);
+  }
+  _buffer.append(value);
+  return *this;
+}
+
+MsgpackWriter &MsgpackWriter::Array(uint32_t size) {
+  if (size <= 15) {
+    _buffer.push_back(static_cast<char>(0x90 | size));
+  } else if (size <= 0xFFFF) {
+    _buffer.push_back(static_cast<char>(0xDC));
+    PutBE(&_buffer, size, 2);
+  } else {
+    _buffer.push_back(static_cast<char>(0xDD));
+    PutBE(&_buffer, size, 4);
+  }
+  return *this;
+}
+
+MsgpackWriter &MsgpackWriter::Map(uint32_t size) {
+  if (size <= 15) {
+    _buffer.push_back(static_cast<char>(0x80 | size));
+  } else if (size <= 0xFFFF) {
+    _buffer.push_back(static_cast<char>(0xDE));
+    PutBE(&_buffer, size, 2);
+  } else {
+    _buffer.push_back(static_cast<char>(0xDF));
+    PutBE(&_buffer, size, 4);
+  }
+  return *this;
+}
+
+static uint64_t GetBE(const uint8_t *p, int bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+// advance p over one object. false if incomplete or invalid
+static bool Skip(const uint8_t *&p, const uint8_t *end) {
+  if (p >= end) {
+    return false;
+  }
+  auto available = static_cast<size_t>(end - p);
+  auto skip_bytes = [&](size_t header, size_t payload) {
+    if (available < header + payload) {
+      return false;
+    }
+    p += header + payload;
+    return true;
+  };
+  auto skip_items = [&](size_t header, uint64_t count) {
+    if (available < header) {
+      return false;
+    }
+    p += header;
+    for (uint64_t i = 0; i < count; ++i) {
+      if (!Skip(p, end)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  auto type = p[0];
+  if (type <= 0x7F || type >= 0xE0 || type == 0xC0 || type == 0xC2 ||
+      type == 0xC3) {
+    return skip_bytes(1, 0);
+  }
+  if ((type & 0xF0) == 0x80) {
+    return skip_items(1, (type & 0x0F) * 2);
+  }
+  if ((type & 0xF0) == 0x90) {
+    return skip_items(1, type & 0x0F);
+  }
+  if ((type & 0xE0) == 0xA0) {
+    return skip_bytes(1, type & 0x1F);
+  }
+  switch (type) {
+  case 0xC4: // bin, str
+  case 0xD9:
+    return available >= 2 && skip_bytes(2, GetBE(p + 1, 1));
+  case 0xC5:
+  case 0xDA:
+    return available >= 3 && skip_bytes(3, GetBE(p + 1, 2));
+  case 0xC6:
+  case 0xDB:
+    return available >= 5 && skip_bytes(5, GetBE(p + 1, 4));
+  case 0xC7: // ext
+    return available >= 2 && skip_bytes(3, GetBE(p + 1, 1));
+  case 0xC8:
+    return available >= 3 && skip_bytes(4, GetBE(p + 1, 2));
+  case 0xC9:
+    return available >= 5 && skip_bytes(6, GetBE(p + 1, 4));
+  case 0xCA: // float
+    return skip_bytes(5, 0);
+  case 0xCB:
+    return skip_bytes(9, 0);
+  case 0xCC: // int
+  case 0xD0:
+    return skip_bytes(2, 0);
+  case 0xCD:
+  case 0xD1:
+    return skip_bytes(3, 0);
+  case 0xCE:
+  case 0xD2:
+    return skip_bytes(5, 0);
+  case 0xCF:
+  case 0xD3:
+    return skip_bytes(9, 0);
+  case 0xD4: // fixext
+    return skip_bytes(3, 0);
+  case 0xD5:
+    return skip_bytes(4, 0);
+  case 0xD6:
+    return skip_bytes(6, 0);
+  case 0xD7:
+    return skip_bytes(10, 0);
+  case 0xD8:
+    return skip_bytes(18, 0);
+  case 0xDC: // array
+    return available >= 3 && skip_items(3, GetBE(p + 1, 2));
+  case 0xDD:
+    return available >= 5 && skip_items(5, GetBE(p + 1, 4));
+  case 0xDE: // map
+    return available >= 3 && skip_items(3, GetBE(p + 1, 2) * 2);
+  case 0xDF:
+    return available >= 5 && skip_items(5, GetBE(p + 1, 4) * 2);
+  }
+  return false;
+}
+
+static bool ReadUInt(const uint8_t *p, const uint8_t *end, uint64_t *value) {
+  if (p >= end) {
+    return false;
+  }
+  if (p[0] <= 0x7F) {
+    *value = p[0];
+    return true;
+  }
+  int bytes = p[0] == 0xCC ? 1 : p[0] == 0xCD ? 2 : p[0] == 0xCE ? 4 : p[0] == 0xCF ? 8 : 0;
+  if (bytes == 0 || end - p < 1 + bytes) {
+    return false;
+  }
+  *value = GetBE(p + 1, bytes);
+  return true;
+}
+
+static std::string ToUtf8(std::wstring_view src) {
+  auto size = WideCharToMultiByte(CP_UTF8, 0, src.data(),
+                                  static_cast<int>(src.size()), nullptr, 0,
+                                  nullptr, nullptr);
+  std::string utf8(size, '\0');
+  WideCharToMultiByte(CP_UTF8, 0, src.data(), static_cast<int>(src.size()),
+                      utf8.data(), size, nullptr, nullptr);
+  return utf8;
+}
+
+NvimRpc::NvimRpc(std::wstring_view pipe_name) : _pipe_name(pipe_name) {}
+
+NvimRpc::~NvimRpc() { Disconnect(); }
+
+bool NvimRpc::Connect() {
+  if (_pipe) {
+    return true;
+  }
+  // nvim creates the pipe early in startup. retried on the next call
+  auto pipe = CreateFileW(_pipe_name.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+                          nullptr, OPEN_EXISTING, 0, nullptr);
+  if (pipe == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  _pipe = pipe;
+  _read_buffer.clear();
+  return true;
+}
+
+void NvimRpc::Disconnect() {
+  if (_pipe) {
+    CloseHandle(_pipe);
+    _pipe = nullptr;
+  }
+}
+
+bool NvimRpc::Write(const std::string &data) {
+  if (!Connect()) {
+    return false;
+  }
+  DWORD written = 0;
+  if (!WriteFile(_pipe, data.data(), static_cast<DWORD>(data.size()),
+                 &written, nullptr) ||
+      written != data.size()) {
+    Disconnect();
+    return false;
+  }
+  return true;
+}
+
+bool NvimRpc::Notify(std::string_view method, const MsgpackWriter &params) {
+  MsgpackWriter message;
+  message.Array(3).Int(2).Str(method);
+  return Write(message.Buffer() + params.Buffer());
+}
+
+uint32_t NvimRpc::Send(std::string_view method, const MsgpackWriter &params) {
+  auto id = _next_id++;
+  if (_next_id == 0) {
+    _next_id = 1;
+  }
+  MsgpackWriter message;
+  message.Array(4).Int(0).Int(id).Str(method);
+  if (!Write(message.Buffer() + params.Buffer())) {
+    return 0;
+  }
+  return id;
+}
+
+RpcState NvimRpc::Poll(uint32_t id, bool *result) {
+  if (!_pipe) {
+    return RpcState::Failed;
+  }
+  DWORD available = 0;
+  if (!PeekNamedPipe(_pipe, nullptr, 0, nullptr, &available, nullptr)) {
+    Disconnect();
+    return RpcState::Failed;
+  }
+  if (available == 0) {
+    return RpcState::Pending;
+  }
+  auto offset = _read_buffer.size();
+  _read_buffer.resize(offset + available);
+  DWORD read = 0;
+  if (!ReadFile(_pipe, _read_buffer.data() + offset, available, &read,
+                nullptr)) {
+    Disconnect();
+    return RpcState::Failed;
+  }
+  _read_buffer.resize(offset + read);
+
+  // [1, msgid, error, result]. anything else is skipped
+  auto begin = reinterpret_cast<const uint8_t *>(_read_buffer.data());
+  auto end = begin + _read_buffer.size();
+  auto p = begin;
+  while (true) {
+    auto message_begin = p;
+    if (!Skip(p, end)) {
+      // incomplete. wait for the rest
+      p = message_begin;
+      break;
+    }
+    uint64_t type = 0;
+    uint64_t message_id = 0;
+    auto q = message_begin + 1;
+    if (message_begin[0] != 0x94 || !ReadUInt(q, p, &type) || type != 1) {
+      continue;
+    }
+    ++q;
+    if (!ReadUInt(q, p, &message_id) || message_id != id) {
+      continue;
+    }
+    Skip(q, p);
+    auto error = q;
+    Skip(q, p);
+    *result = error[0] == 0xC0 && q < p && q[0] == 0xC3;
+    _read_buffer.erase(0, p - begin);
+    return RpcState::Done;
+  }
+  _read_buffer.erase(0, p - begin);
+  return RpcState::Pending;
+}
+
+uint32_t NvimRpc::Paste(std::string_view data, int phase) {
+  MsgpackWriter params;
+  params.Array(3).Str(data).Bool(false).Int(phase);
+  return Send("nvim_paste", params);
+}
+
+bool NvimRpc::EndPaste() {
+  MsgpackWriter params;
+  params.Array(3).Str("").Bool(false).Int(3);
+  return Notify("nvim_paste", params);
+}
+
+bool NvimRpc::OpenFiles(const std::vector<std::wstring> &files) {
+  // let nvim escape the names
+  MsgpackWriter params;
+  params.Array(2)
+      .Str("vim.cmd('drop ' .. table.concat("
+           "vim.tbl_map(vim.fn.fnameescape, {...}), ' '))")
+      .Array(static_cast<uint32_t>(files.size()));
+  for (auto &file : files) {
+    params.Str(ToUtf8(file));
+  }
+  return Notify("nvim_exec_lua", params);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+///
+/// Packs rpc params. Only the types the client sends.
+///
+class MsgpackWriter {
+  std::string _buffer;
+
+public:
+  const std::string &Buffer() const { return _buffer; }
+  MsgpackWriter &Nil();
+  MsgpackWriter &Bool(bool value);
+  MsgpackWriter &Int(int64_t value);
+  MsgpackWriter &Double(double value);
+  MsgpackWriter &Str(std::string_view value);
+  MsgpackWriter &Array(uint32_t size);
+  MsgpackWriter &Map(uint32_t size);
+};
+
+enum class RpcState {
+  Pending,
+  Done,
+  // write or read failed
+  Failed,
+};
+
+///
+/// A second msgpack-rpc channel to the embedded nvim, over the named pipe
+/// passed to `nvim --listen`. Redraw stays on the NvimFrontend stdio channel.
+///
+class NvimRpc {
+  std::wstring _pipe_name;
+  void *_pipe = nullptr;
+  uint32_t _next_id = 1;
+  std::string _read_buffer;
+
+  bool Connect();
+  void Disconnect();
+  bool Write(const std::string &data);
+
+public:
+  NvimRpc(std::wstring_view pipe_name);
+  ~NvimRpc();
+  // params: packed array
+  bool Notify(std::string_view method, const MsgpackWriter &params);
+  // returns the request id. 0 on error
+  uint32_t Send(std::string_view method, const MsgpackWriter &params);
+  // read what has arrived without blocking. when Done, result is true if
+  // nvim returned true
+  RpcState Poll(uint32_t id, bool *result);
+
+  // nvim_paste request. the reply is false if nvim cancelled the paste
+  uint32_t Paste(std::string_view data, int phase);
+  // phase 3 without data. for a stream that stops before its last chunk
+  bool EndPaste();
+  // a single :drop for all files
+  bool OpenFiles(const std::vector<std::wstring> &files);
+};
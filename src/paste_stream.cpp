@@ -0,0 +1,111 @@
+#include "paste_stream.h"
+#include "async_log.h"
+#include "nvim_rpc.h"
+#include <Windows.h>
+
+static bool ReadClipboardText(std::wstring *out) {
+  if (!IsClipboardFormatAvailable(CF_UNICODETEXT)) {
+    return false;
+  }
+  if (!OpenClipboard(nullptr)) {
+    return false;
+  }
+
+  auto handle = GetClipboardData(CF_UNICODETEXT);
+  if (handle) {
+    auto text = static_cast<const wchar_t *>(GlobalLock(handle));
+    if (text) {
+      out->assign(text);
+      GlobalUnlock(handle);
+    }
+  }
+
+  CloseClipboard();
+  return !out->empty();
+}
+
+bool PasteStream::Begin() {
+  if (IsActive()) {
+    return false;
+  }
+
+  Reset();
+  return ReadClipboardText(&_text);
+}
+
+void PasteStream::Reset() {
+  // release the clipboard copy
+  _text.clear();
+  _text.shrink_to_fit();
+  _pos = 0;
+  _phase = 0;
+  _request = 0;
+}
+
+size_t PasteStream::Pump(NvimRpc *rpc) {
+  if (!IsActive()) {
+    return 0;
+  }
+
+  if (_request) {
+    bool accepted = false;
+    auto state = rpc->Poll(_request, &accepted);
+    if (state == RpcState::Pending) {
+      if (GetTickCount64() - _sent_at < TIMEOUT_MS) {
+        return 0;
+      }
+      NVY_LOGW("nvim_paste: no response. ending the paste");
+      state = RpcState::Failed;
+    }
+    _request = 0;
+    if (state == RpcState::Failed) {
+      if (_phase == 1 || _phase == 2) {
+        // do not leave nvim in the middle of a paste
+        rpc->EndPaste();
+      }
+      Reset();
+      return 0;
+    }
+    if (!accepted || _pos == _text.size()) {
+      // cancelled in nvim, or the last chunk was answered
+      Reset();
+      return 0;
+    }
+  }
+
+  auto end = _pos + CHUNK_SIZE;
+  if (end >= _text.size()) {
+    end = _text.size();
+  } else {
+    // keep a surrogate pair or a CRLF in the same chunk
+    if (IS_HIGH_SURROGATE(_text[end - 1]) ||
+        (_text[end - 1] == L'\r' && _text[end] == L'\n')) {
+      ++end;
+    }
+  }
+
+  auto src = _text.data() + _pos;
+  auto src_size = static_cast<int>(end - _pos);
+  auto size = WideCharToMultiByte(CP_UTF8, 0, src, src_size, nullptr, 0,
+                                  nullptr, nullptr);
+  _utf8.resize(size);
+  WideCharToMultiByte(CP_UTF8, 0, src, src_size, _utf8.data(), size, nullptr,
+                      nullptr);
+
+  auto first = _phase == 0;
+  auto last = end == _text.size();
+  int phase = first && last ? -1 : first ? 1 : last ? 3 : 2;
+  _request = rpc->Paste(_utf8, phase);
+  if (!_request) {
+    if (!first) {
+      rpc->EndPaste();
+    }
+    Reset();
+    return 0;
+  }
+  NVY_LOGV("paste {} bytes, phase {}", _utf8.size(), phase);
+  _phase = phase;
+  _sent_at = GetTickCount64();
+  _pos = end;
+  return _utf8.size();
+}
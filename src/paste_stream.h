@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+class NvimRpc;
+
+///
+/// Streams clipboard text to nvim_paste in bounded chunks.
+/// One request is in flight at a time. The next chunk is sent once nvim has
+/// answered, so the main loop never waits for nvim.
+///
+class PasteStream {
+  std::wstring _text;
+  size_t _pos = 0;
+  // nvim_paste phase of the last chunk sent. 0 before the first chunk
+  int _phase = 0;
+  // the request in flight
+  uint32_t _request = 0;
+  uint64_t _sent_at = 0;
+  std::string _utf8;
+
+  void Reset();
+
+public:
+  // wchar_t units per nvim_paste call
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+  // the paste is ended if nvim does not answer a chunk in time
+  static constexpr uint64_t TIMEOUT_MS = 5000;
+
+  // read CF_UNICODETEXT. false if the clipboard is empty or a paste is
+  // still streaming
+  bool Begin();
+  bool IsActive() const { return _request != 0 || _pos < _text.size(); }
+  // call once per main loop iteration. never blocks.
+  // returns the bytes sent
+  size_t Pump(NvimRpc *rpc);
+};
@@ -1,6 +1,6 @@
 #include "d3d.h"
 
-std::unique_ptr<D3D> D3D::Create() {
+std::unique_ptr<D3D> D3D::Create(bool use_warp) {
   uint32_t flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
 #ifndef NDEBUG
   flags |= D3D11_CREATE_DEVICE_DEBUG;
@@ -14,15 +14,29 @@ std::unique_ptr<D3D> D3D::Create() {
       D3D_FEATURE_LEVEL_11_1, D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_1,
       D3D_FEATURE_LEVEL_10_0, D3D_FEATURE_LEVEL_9_3,  D3D_FEATURE_LEVEL_9_2,
       D3D_FEATURE_LEVEL_9_1};
-  auto hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, flags,
-                              feature_levels, ARRAYSIZE(feature_levels),
-                              D3D11_SDK_VERSION, &temp_device,
-                              &d3d_feature_level, &temp_context);
+  // WARP is the fallback when no hardware device is available (VDI)
+  D3D_DRIVER_TYPE driver_types[] = {D3D_DRIVER_TYPE_HARDWARE,
+                                    D3D_DRIVER_TYPE_WARP};
+  HRESULT hr = E_FAIL;
+  D3D_DRIVER_TYPE driver_type = D3D_DRIVER_TYPE_UNKNOWN;
+  for (auto type : driver_types) {
+    if (use_warp && type != D3D_DRIVER_TYPE_WARP) {
+      continue;
+    }
+    hr = D3D11CreateDevice(nullptr, type, nullptr, flags, feature_levels,
+                           ARRAYSIZE(feature_levels), D3D11_SDK_VERSION,
+                           &temp_device, &d3d_feature_level, &temp_context);
+    if (SUCCEEDED(hr)) {
+      driver_type = type;
+      break;
+    }
+  }
   if (FAILED(hr)) {
     return nullptr;
   }
 
   auto p = std::unique_ptr<D3D>(new D3D);
+  p->_driver_type = driver_type;
 
   hr = temp_device.As(&p->_device);
   if (FAILED(hr)) {
@@ -7,11 +7,14 @@ class D3D {
   template <typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
   ComPtr<ID3D11Device2> _device;
   ComPtr<ID3D11DeviceContext2> _context;
+  D3D_DRIVER_TYPE _driver_type = D3D_DRIVER_TYPE_UNKNOWN;
 
   D3D(){}
 public:
   ~D3D(){}
-  static std::unique_ptr<D3D> Create();
+  // use_warp: skip the hardware device and rasterize on the CPU
+  static std::unique_ptr<D3D> Create(bool use_warp = false);
   const ComPtr<ID3D11Device2> &Device() const { return _device; }
   const ComPtr<ID3D11DeviceContext2> &Context() const { return _context; }
+  bool IsWarp() const { return _driver_type == D3D_DRIVER_TYPE_WARP; }
 };
@@ -0,0 +1,251 @@
+#include "frame_snapshot.h"
+#include <algorithm>
+#include <string.h>
+template <typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x4659564E; // "NVYF"
+constexpr uint32_t SNAPSHOT_VERSION = 2;
+constexpr uint32_t SNAPSHOT_MAXIMIZED = 1;
+constexpr uint32_t RUN_BIT = 0x80000000;
+constexpr size_t MAX_TOKEN_COUNT = 0x7FFFFFFF;
+
+struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t dpi;
+  uint32_t flags;
+  uint32_t packed_count;
+};
+
+// token & RUN_BIT: (token & ~RUN_BIT) copies of the next pixel.
+// otherwise: token literal pixels follow.
+static void Pack(const uint32_t *pixels, size_t size,
+                 std::vector<uint32_t> *out) {
+  size_t i = 0;
+  while (i < size) {
+    size_t run = 1;
+    while (i + run < size && pixels[i + run] == pixels[i] &&
+           run < MAX_TOKEN_COUNT) {
+      ++run;
+    }
+    if (run >= 3) {
+      out->push_back(RUN_BIT | static_cast<uint32_t>(run));
+      out->push_back(pixels[i]);
+      i += run;
+      continue;
+    }
+
+    auto start = i;
+    while (i < size && i - start < MAX_TOKEN_COUNT) {
+      if (i + 2 < size && pixels[i] == pixels[i + 1] &&
+          pixels[i] == pixels[i + 2]) {
+        break;
+      }
+      ++i;
+    }
+    out->push_back(static_cast<uint32_t>(i - start));
+    out->insert(out->end(), pixels + start, pixels + i);
+  }
+}
+
+static bool Unpack(const std::vector<uint32_t> &packed, uint32_t *pixels,
+                   size_t size) {
+  size_t src = 0;
+  size_t dst = 0;
+  while (src < packed.size()) {
+    auto token = packed[src++];
+    size_t count = token & ~RUN_BIT;
+    if (dst + count > size) {
+      return false;
+    }
+    if (token & RUN_BIT) {
+      if (src >= packed.size()) {
+        return false;
+      }
+      std::fill(pixels + dst, pixels + dst + count, packed[src++]);
+    } else {
+      if (src + count > packed.size()) {
+        return false;
+      }
+      std::copy(packed.data() + src, packed.data() + src + count,
+                pixels + dst);
+      src += count;
+    }
+    dst += count;
+  }
+  return dst == size;
+}
+
+std::wstring FrameSnapshot::DefaultPath() {
+  wchar_t local_app_data[MAX_PATH];
+  auto length = GetEnvironmentVariableW(L"LOCALAPPDATA", local_app_data,
+                                        MAX_PATH);
+  if (length == 0 || length >= MAX_PATH) {
+    return {};
+  }
+  std::wstring dir = local_app_data;
+  dir += L"\\Nvy";
+  CreateDirectoryW(dir.c_str(), nullptr);
+  return dir + L"\\last_frame.bin";
+}
+
+std::unique_ptr<FrameSnapshot>
+FrameSnapshot::Capture(const ComPtr<ID3D11Device2> &d3d_device,
+                       const ComPtr<ID3D11DeviceContext2> &d3d_context,
+                       IDXGISurface2 *backbuffer, uint32_t dpi) {
+  if (!backbuffer) {
+    return nullptr;
+  }
+  ComPtr<ID3D11Texture2D> texture;
+  auto hr = backbuffer->QueryInterface(IID_PPV_ARGS(&texture));
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+
+  D3D11_TEXTURE2D_DESC desc;
+  texture->GetDesc(&desc);
+  desc.BindFlags = 0;
+  desc.MiscFlags = 0;
+  desc.Usage = D3D11_USAGE_STAGING;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+  ComPtr<ID3D11Texture2D> staging;
+  hr = d3d_device->CreateTexture2D(&desc, nullptr, &staging);
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+  d3d_context->CopyResource(staging.Get(), texture.Get());
+
+  D3D11_MAPPED_SUBRESOURCE mapped;
+  hr = d3d_context->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+  std::vector<uint32_t> pixels(static_cast<size_t>(desc.Width) * desc.Height);
+  for (uint32_t y = 0; y < desc.Height; ++y) {
+    auto row = static_cast<const uint8_t *>(mapped.pData) + y * mapped.RowPitch;
+    memcpy(pixels.data() + static_cast<size_t>(y) * desc.Width, row,
+           desc.Width * sizeof(uint32_t));
+  }
+  d3d_context->Unmap(staging.Get(), 0);
+
+  auto p = std::unique_ptr<FrameSnapshot>(new FrameSnapshot);
+  p->_width = desc.Width;
+  p->_height = desc.Height;
+  p->_dpi = dpi;
+  Pack(pixels.data(), pixels.size(), &p->_packed);
+  return p;
+}
+
+std::unique_ptr<FrameSnapshot> FrameSnapshot::Load(const wchar_t *path) {
+  auto file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+
+  std::unique_ptr<FrameSnapshot> p;
+  SnapshotHeader header;
+  DWORD read = 0;
+  LARGE_INTEGER file_size;
+  // the size must match before packed_count is trusted for an allocation
+  if (GetFileSizeEx(file, &file_size) &&
+      ReadFile(file, &header, sizeof(header), &read, nullptr) &&
+      read == sizeof(header) && header.magic == SNAPSHOT_MAGIC &&
+      header.version == SNAPSHOT_VERSION && header.width > 0 &&
+      header.height > 0 && header.width <= 16384 && header.height <= 16384 &&
+      header.packed_count <= header.width * header.height * 2 &&
+      static_cast<uint64_t>(file_size.QuadPart) ==
+          sizeof(header) + static_cast<uint64_t>(header.packed_count) *
+                               sizeof(uint32_t)) {
+    p = std::unique_ptr<FrameSnapshot>(new FrameSnapshot);
+    p->_width = header.width;
+    p->_height = header.height;
+    p->_dpi = header.dpi;
+    p->_maximized = (header.flags & SNAPSHOT_MAXIMIZED) != 0;
+    p->_packed.resize(header.packed_count);
+    auto bytes = static_cast<DWORD>(p->PackedBytes());
+    if (!ReadFile(file, p->_packed.data(), bytes, &read, nullptr) ||
+        read != bytes) {
+      p.reset();
+    }
+  }
+
+  CloseHandle(file);
+  return p;
+}
+
+bool FrameSnapshot::Save(const wchar_t *path, bool maximized) const {
+  // write aside and swap, so a crash never leaves a torn snapshot
+  std::wstring tmp = path;
+  tmp += L".tmp";
+  auto file = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, nullptr,
+                          CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  SnapshotHeader header{
+      .magic = SNAPSHOT_MAGIC,
+      .version = SNAPSHOT_VERSION,
+      .width = _width,
+      .height = _height,
+      .dpi = _dpi,
+      .flags = maximized ? SNAPSHOT_MAXIMIZED : 0,
+      .packed_count = static_cast<uint32_t>(_packed.size()),
+  };
+  auto bytes = static_cast<DWORD>(PackedBytes());
+  DWORD written = 0;
+  bool ok = WriteFile(file, &header, sizeof(header), &written, nullptr) &&
+            written == sizeof(header) &&
+            WriteFile(file, _packed.data(), bytes, &written, nullptr) &&
+            written == bytes;
+  CloseHandle(file);
+
+  if (!ok) {
+    DeleteFileW(tmp.c_str());
+    return false;
+  }
+  return MoveFileExW(tmp.c_str(), path, MOVEFILE_REPLACE_EXISTING);
+}
+
+bool FrameSnapshot::Restore(const ComPtr<ID3D11Device2> &d3d_device,
+                            const ComPtr<ID3D11DeviceContext2> &d3d_context,
+                            IDXGISurface2 *backbuffer) const {
+  if (!backbuffer) {
+    return false;
+  }
+  ComPtr<ID3D11Texture2D> texture;
+  auto hr = backbuffer->QueryInterface(IID_PPV_ARGS(&texture));
+  if (FAILED(hr)) {
+    return false;
+  }
+
+  D3D11_TEXTURE2D_DESC desc;
+  texture->GetDesc(&desc);
+  if (desc.Width != _width || desc.Height != _height) {
+    return false;
+  }
+
+  std::vector<uint32_t> pixels(static_cast<size_t>(_width) * _height);
+  if (!Unpack(_packed, pixels.data(), pixels.size())) {
+    return false;
+  }
+
+  desc.BindFlags = 0;
+  desc.MiscFlags = 0;
+  desc.Usage = D3D11_USAGE_DEFAULT;
+  desc.CPUAccessFlags = 0;
+  D3D11_SUBRESOURCE_DATA data{
+      .pSysMem = pixels.data(),
+      .SysMemPitch = _width * static_cast<uint32_t>(sizeof(uint32_t)),
+  };
+  ComPtr<ID3D11Texture2D> upload;
+  hr = d3d_device->CreateTexture2D(&desc, &data, &upload);
+  if (FAILED(hr)) {
+    return false;
+  }
+  d3d_context->CopyResource(texture.Get(), upload.Get());
+  return true;
+}
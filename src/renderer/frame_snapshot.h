@@ -0,0 +1,44 @@
+#pragma once
+#include <d3d11_2.h>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <wrl/client.h>
+
+///
+/// A presented frame, packed for the disk.
+/// Shown at startup until nvim sends the first redraw.
+///
+class FrameSnapshot {
+  template <typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+  uint32_t _width = 0;
+  uint32_t _height = 0;
+  uint32_t _dpi = 0;
+  // the window was maximized or fullscreen when saved
+  bool _maximized = false;
+  // run length encoded B8G8R8A8 pixels
+  std::vector<uint32_t> _packed;
+
+  FrameSnapshot() {}
+
+public:
+  ~FrameSnapshot() {}
+  // %LOCALAPPDATA%\Nvy\last_frame.bin
+  static std::wstring DefaultPath();
+  static std::unique_ptr<FrameSnapshot>
+  Capture(const ComPtr<ID3D11Device2> &d3d_device,
+          const ComPtr<ID3D11DeviceContext2> &d3d_context,
+          IDXGISurface2 *backbuffer, uint32_t dpi);
+  static std::unique_ptr<FrameSnapshot> Load(const wchar_t *path);
+  bool Save(const wchar_t *path, bool maximized) const;
+  // copy to the backbuffer. false if the size does not match
+  bool Restore(const ComPtr<ID3D11Device2> &d3d_device,
+               const ComPtr<ID3D11DeviceContext2> &d3d_context,
+               IDXGISurface2 *backbuffer) const;
+  uint32_t Width() const { return _width; }
+  uint32_t Height() const { return _height; }
+  uint32_t Dpi() const { return _dpi; }
+  bool Maximized() const { return _maximized; }
+  size_t PackedBytes() const { return _packed.size() * sizeof(uint32_t); }
+};
@@ -0,0 +1,203 @@
+#include "stats_overlay.h"
+#include <float.h>
+template <typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+constexpr float OVERLAY_FONT_SIZE = 12.0f;
+constexpr float OVERLAY_PADDING = 6.0f;
+
+std::unique_ptr<StatsOverlay>
+StatsOverlay::Create(const ComPtr<ID3D11Device2> &d3d_device, uint32_t dpi) {
+  ComPtr<ID2D1Factory1> d2d_factory;
+  auto hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED,
+                              d2d_factory.GetAddressOf());
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+
+  ComPtr<IDXGIDevice> dxgi_device;
+  hr = d3d_device.As(&dxgi_device);
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+
+  ComPtr<ID2D1Device> d2d_device;
+  hr = d2d_factory->CreateDevice(dxgi_device.Get(), &d2d_device);
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+
+  auto p = std::unique_ptr<StatsOverlay>(new StatsOverlay);
+  hr = d2d_device->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE,
+                                       &p->_d2d_context);
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+
+  hr = DWriteCreateFactory(
+      DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory),
+      reinterpret_cast<IUnknown **>(p->_dwrite_factory.GetAddressOf()));
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+
+  // the target bitmap is 96 dpi, so scale the font by hand
+  hr = p->_dwrite_factory->CreateTextFormat(
+      L"Consolas", nullptr, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
+      DWRITE_FONT_STRETCH_NORMAL, OVERLAY_FONT_SIZE * dpi / 96.0f, L"en-us",
+      &p->_text_format);
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+
+  hr = p->_d2d_context->CreateSolidColorBrush(D2D1::ColorF(0xFFFFFF),
+                                              &p->_text_brush);
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+  hr = p->_d2d_context->CreateSolidColorBrush(D2D1::ColorF(0x000000, 0.75f),
+                                              &p->_background_brush);
+  if (FAILED(hr)) {
+    return nullptr;
+  }
+
+  return p;
+}
+
+void StatsOverlay::SetText(std::wstring_view text) {
+  _layout.Reset();
+  if (text.empty()) {
+    return;
+  }
+  // lines are broken by the text only
+  auto hr = _dwrite_factory->CreateTextLayout(
+      text.data(), static_cast<UINT32>(text.size()), _text_format.Get(),
+      FLT_MAX, FLT_MAX, &_layout);
+  if (FAILED(hr)) {
+    _layout.Reset();
+    return;
+  }
+  _layout->GetMetrics(&_metrics);
+}
+
+void StatsOverlay::ReleaseTarget() {
+  _target.Reset();
+  _target_surface = nullptr;
+}
+
+void StatsOverlay::Draw(const ComPtr<ID3D11Device2> &d3d_device,
+                        const ComPtr<ID3D11DeviceContext2> &d3d_context,
+                        IDXGISurface2 *backbuffer) {
+  _drawn = false;
+  if (!backbuffer || !_layout) {
+    return;
+  }
+  ComPtr<ID3D11Texture2D> texture;
+  auto hr = backbuffer->QueryInterface(IID_PPV_ARGS(&texture));
+  if (FAILED(hr)) {
+    return;
+  }
+  D3D11_TEXTURE2D_DESC desc;
+  texture->GetDesc(&desc);
+
+  // top right corner
+  auto width = static_cast<uint32_t>(_metrics.width + OVERLAY_PADDING * 2) + 1;
+  auto height =
+      static_cast<uint32_t>(_metrics.height + OVERLAY_PADDING * 2) + 1;
+  if (width > desc.Width || height > desc.Height) {
+    return;
+  }
+  _box = {.left = desc.Width - width,
+          .top = 0,
+          .front = 0,
+          .right = desc.Width,
+          .bottom = height,
+          .back = 1};
+
+  // save the pixels under the box
+  D3D11_TEXTURE2D_DESC saved_desc{};
+  if (_saved) {
+    _saved->GetDesc(&saved_desc);
+  }
+  if (saved_desc.Width < width || saved_desc.Height < height) {
+    _saved.Reset();
+    saved_desc = desc;
+    saved_desc.Width = width;
+    saved_desc.Height = height;
+    saved_desc.BindFlags = 0;
+    saved_desc.MiscFlags = 0;
+    saved_desc.Usage = D3D11_USAGE_DEFAULT;
+    saved_desc.CPUAccessFlags = 0;
+    hr = d3d_device->CreateTexture2D(&saved_desc, nullptr, &_saved);
+    if (FAILED(hr)) {
+      return;
+    }
+  }
+  d3d_context->CopySubresourceRegion(_saved.Get(), 0, 0, 0, 0, texture.Get(),
+                                     0, &_box);
+
+  if (!_target || _target_surface != backbuffer) {
+    _target.Reset();
+    auto props = D2D1::BitmapProperties1(
+        D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_IGNORE));
+    hr = _d2d_context->CreateBitmapFromDxgiSurface(backbuffer, &props,
+                                                   &_target);
+    if (FAILED(hr)) {
+      ReleaseTarget();
+      return;
+    }
+    _target_surface = backbuffer;
+  }
+
+  auto left = static_cast<float>(_box.left);
+  _d2d_context->SetTarget(_target.Get());
+  _d2d_context->BeginDraw();
+  _d2d_context->FillRectangle(
+      D2D1::RectF(left, 0, static_cast<float>(_box.right),
+                  static_cast<float>(_box.bottom)),
+      _background_brush.Get());
+  _d2d_context->DrawTextLayout(
+      D2D1::Point2F(left + OVERLAY_PADDING, OVERLAY_PADDING), _layout.Get(),
+      _text_brush.Get());
+  hr = _d2d_context->EndDraw();
+  _d2d_context->SetTarget(nullptr);
+  if (FAILED(hr)) {
+    // do not present a half drawn box
+    PutBack(d3d_context, texture.Get());
+    _lost = hr == D2DERR_RECREATE_TARGET;
+    return;
+  }
+
+  _drawn = true;
+}
+
+void StatsOverlay::PutBack(const ComPtr<ID3D11DeviceContext2> &d3d_context,
+                           ID3D11Texture2D *texture) {
+  D3D11_BOX src{.left = 0,
+                .top = 0,
+                .front = 0,
+                .right = _box.right - _box.left,
+                .bottom = _box.bottom - _box.top,
+                .back = 1};
+  d3d_context->CopySubresourceRegion(texture, 0, _box.left, _box.top, 0,
+                                     _saved.Get(), 0, &src);
+}
+
+void StatsOverlay::Restore(const ComPtr<ID3D11DeviceContext2> &d3d_context,
+                           IDXGISurface2 *backbuffer) {
+  if (!_drawn || !backbuffer) {
+    return;
+  }
+  _drawn = false;
+  ComPtr<ID3D11Texture2D> texture;
+  auto hr = backbuffer->QueryInterface(IID_PPV_ARGS(&texture));
+  if (FAILED(hr)) {
+    return;
+  }
+  D3D11_TEXTURE2D_DESC desc;
+  texture->GetDesc(&desc);
+  if (_box.right > desc.Width || _box.bottom > desc.Height) {
+    return;
+  }
+  PutBack(d3d_context, texture.Get());
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <d2d1_1.h>
+#include <d3d11_2.h>
+#include <dwrite.h>
+#include <memory>
+#include <string_view>
+#include <wrl/client.h>
+
+///
+/// Text box drawn over the presented frame.
+/// The renderer only redraws damaged cells, so the pixels under the box are
+/// saved before Draw and put back by Restore after present.
+///
+class StatsOverlay {
+  template <typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+  ComPtr<ID2D1DeviceContext> _d2d_context;
+  ComPtr<IDWriteFactory> _dwrite_factory;
+  ComPtr<IDWriteTextFormat> _text_format;
+  ComPtr<ID2D1SolidColorBrush> _text_brush;
+  ComPtr<ID2D1SolidColorBrush> _background_brush;
+  // rebuilt by SetText
+  ComPtr<IDWriteTextLayout> _layout;
+  DWRITE_TEXT_METRICS _metrics{};
+  // the backbuffer as a D2D target. kept until ReleaseTarget
+  IDXGISurface2 *_target_surface = nullptr;
+  ComPtr<ID2D1Bitmap1> _target;
+  ComPtr<ID3D11Texture2D> _saved;
+  D3D11_BOX _box{};
+  bool _drawn = false;
+  bool _lost = false;
+
+  StatsOverlay() {}
+  void PutBack(const ComPtr<ID3D11DeviceContext2> &d3d_context,
+               ID3D11Texture2D *texture);
+
+public:
+  ~StatsOverlay() {}
+  static std::unique_ptr<StatsOverlay>
+  Create(const ComPtr<ID3D11Device2> &d3d_device, uint32_t dpi);
+  void SetText(std::wstring_view text);
+  void Draw(const ComPtr<ID3D11Device2> &d3d_device,
+            const ComPtr<ID3D11DeviceContext2> &d3d_context,
+            IDXGISurface2 *backbuffer);
+  void Restore(const ComPtr<ID3D11DeviceContext2> &d3d_context,
+               IDXGISurface2 *backbuffer);
+  // EndDraw returned D2DERR_RECREATE_TARGET. create a new overlay
+  bool IsLost() const { return _lost; }
+  // the target holds a reference to the backbuffer. call before the
+  // swapchain is resized
+  void ReleaseTarget();
+};
@@ -81,6 +81,9 @@ HRESULT Swapchain::Resize(uint32_t w, uint32_t h) {
       2, w, h, DXGI_FORMAT_B8G8R8A8_UNORM,
       DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT |
           DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING);
+  if (SUCCEEDED(hr)) {
+    _dxgi_swapchain->GetDesc(&_desc);
+  }
   return hr;
 }
 
@@ -61,6 +61,13 @@ void *Win32Window::Create(void *instance, const wchar_t *class_name,
 uint64_t Win32Window::Proc(void *hwnd, uint32_t msg, uint64_t wparam,
                            uint64_t lparam) {
 
+  // Shift+Insert. stream the clipboard instead of sending keys
+  if (msg == WM_KEYDOWN && wparam == VK_INSERT &&
+      (GetKeyState(VK_SHIFT) & 0x80) != 0 && _on_paste) {
+    _on_paste();
+    return 0;
+  }
+
   uint64_t out;
   if (_nvim_Key.ProcessMessage(hwnd, msg, wparam, lparam, _on_input, &out)) {
     return out;
@@ -68,7 +75,9 @@ uint64_t Win32Window::Proc(void *hwnd, uint32_t msg, uint64_t wparam,
 
   switch (msg) {
   case WM_SIZE: {
-    if (wparam != SIZE_MINIMIZED) {
+    _minimized = wparam == SIZE_MINIMIZED;
+    if (!_minimized) {
+      _maximized = wparam == SIZE_MAXIMIZED;
       uint32_t new_width = LOWORD(lparam);
       uint32_t new_height = HIWORD(lparam);
       _on_resize(new_width, new_height);
@@ -187,15 +196,19 @@ uint64_t Win32Window::Proc(void *hwnd, uint32_t msg, uint64_t wparam,
   }
 
   case WM_DROPFILES: {
-    wchar_t file_to_open[MAX_PATH];
-    uint32_t num_files = DragQueryFileW(reinterpret_cast<HDROP>(wparam),
-                                        0xFFFFFFFF, file_to_open, MAX_PATH);
-    for (int i = 0; i < num_files; ++i) {
-      DragQueryFileW(reinterpret_cast<HDROP>(wparam), i, file_to_open,
-                     MAX_PATH);
-      if (_on_drop_file) {
-        _on_drop_file(file_to_open);
-      }
+    auto hdrop = reinterpret_cast<HDROP>(wparam);
+    uint32_t num_files = DragQueryFileW(hdrop, 0xFFFFFFFF, nullptr, 0);
+    std::vector<std::wstring> files;
+    files.reserve(num_files);
+    for (uint32_t i = 0; i < num_files; ++i) {
+      uint32_t length = DragQueryFileW(hdrop, i, nullptr, 0);
+      std::wstring file(length, L'\0');
+      DragQueryFileW(hdrop, i, file.data(), length + 1);
+      files.push_back(std::move(file));
+    }
+    DragFinish(hdrop);
+    if (_on_drop_files && !files.empty()) {
+      _on_drop_files(files);
     }
     return 0;
   }
@@ -220,6 +233,11 @@ bool Win32Window::Loop() {
   return true;
 }
 
+void Win32Window::Wait(uint32_t timeout_ms) {
+  MsgWaitForMultipleObjectsEx(0, nullptr, timeout_ms, QS_ALLINPUT,
+                              MWMO_INPUTAVAILABLE);
+}
+
 void Win32Window::ToggleFullscreen() {
   auto hwnd = (HWND)_hwnd;
   DWORD style = GetWindowLong(hwnd, GWL_STYLE);
@@ -233,10 +251,12 @@ void Win32Window::ToggleFullscreen() {
                    mi.rcMonitor.right - mi.rcMonitor.left,
                    mi.rcMonitor.bottom - mi.rcMonitor.top,
                    SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
+      _fullscreen = true;
     }
   } else {
     SetWindowLong(hwnd, GWL_STYLE, style | WS_OVERLAPPEDWINDOW);
     SetWindowPlacement(hwnd, &saved_window_placement);
+    _fullscreen = false;
     SetWindowPos(hwnd, NULL, 0, 0, 0, 0,
                  SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_NOOWNERZORDER |
                      SWP_FRAMECHANGED);
@@ -244,10 +264,8 @@ void Win32Window::ToggleFullscreen() {
 }
 
 void Win32Window::Resize(int w, int h) {
-  RECT client_rect;
-  auto hwnd = (HWND)_hwnd;
-  GetClientRect(hwnd, &client_rect);
-  MoveWindow(hwnd, client_rect.left, client_rect.top, w, h, false);
+  SetWindowPos((HWND)_hwnd, nullptr, 0, 0, w, h,
+               SWP_NOMOVE | SWP_NOZORDER | SWP_NOACTIVATE);
 }
 
 std::tuple<int, int> Win32Window::Size() const {
@@ -3,16 +3,23 @@
 #include <nvim_win32_key_processor.h>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 using on_int2_t = std::function<void(int, int)>;
 using on_input_t = std::function<void(const Nvim::InputEvent &)>;
 using on_mouse_t = std::function<void(const Nvim::MouseEvent &)>;
-using on_drop_file_t = std::function<void(const wchar_t *file)>;
+using on_drop_files_t =
+    std::function<void(const std::vector<std::wstring> &files)>;
+using on_paste_t = std::function<void()>;
 
 class Win32Window {
   void *_instance = nullptr;
   void *_hwnd = nullptr;
   std::wstring _class_name;
+  bool _minimized = false;
+  // kept while minimized
+  bool _maximized = false;
+  bool _fullscreen = false;
 
   NvimWin32KeyProcessor _nvim_Key;
 
@@ -21,7 +28,8 @@ public:
   on_int2_t _on_resize = [](auto, auto) {};
   on_input_t _on_input;
   on_mouse_t _on_mouse;
-  on_drop_file_t _on_drop_file;
+  on_drop_files_t _on_drop_files;
+  on_paste_t _on_paste;
 
   void *Create(void *instance, const wchar_t *class_name,
                const wchar_t *window_title);
@@ -29,7 +37,13 @@ public:
   uint64_t Proc(void *hwnd, uint32_t msg, uint64_t wparam, uint64_t lparam);
 
   bool Loop();
+  // sleep until a message arrives or timeout
+  void Wait(uint32_t timeout_ms);
+  bool IsMinimized() const { return _minimized; }
+  // maximized or fullscreen. valid after the window is destroyed
+  bool IsMaximized() const { return _maximized || _fullscreen; }
   void ToggleFullscreen();
+  // keeps the position
   void Resize(int w, int h);
   std::tuple<int, int> Size() const;
   uint32_t GetMonitorDpi() const;